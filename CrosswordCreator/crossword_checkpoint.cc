@@ -0,0 +1,179 @@
+//
+//  crossword_checkpoint.cc
+//  CrosswordCreator
+//
+//  Created by Hunter Knepshield on 10/18/26.
+//  Copyright © 2026 Hunter Knepshield. All rights reserved.
+//
+
+// This file contains implementations for saving and restoring in-progress
+// Crossword::Solve searches.
+
+#include "crossword_type.h"
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/// The first line of every checkpoint file, bumped whenever the format changes.
+const char* const CHECKPOINT_HEADER = "CrosswordCreator-checkpoint-1";
+
+/// Returns true if word is made up of nothing but uppercase letters.
+bool AllLetters(const std::string& word) {
+	for (char character : word)
+		if (character < 'A' || character > 'Z') return false;
+	return true;
+}
+
+}  // namespace
+
+bool Crossword::writeCheckpoint(const std::string& filename,
+								const SearchState& state,
+								const BranchAndBound* bnb) const {
+	// Write everything to a temporary file first and then rename it over the
+	// old checkpoint, so a kill mid-write never leaves a truncated checkpoint.
+	const std::string temporaryFilename = temporaryCheckpointFilename(filename);
+	{
+		std::ofstream file(temporaryFilename, std::ios::trunc);
+		if (!file) return false;
+		file << CHECKPOINT_HEADER << std::endl;
+		file << height_ << ' ' << width_ << std::endl;
+		auto writeGrid = [&](const Crossword& puzzle) {
+			for (const auto& row : puzzle.grid_) {
+				for (const auto& cell : row) file << std::get<0>(cell);
+				file << std::endl;
+			}
+		};
+		writeGrid(*this);
+		file << state.generator << std::endl;
+
+		// Whether this is a SolveOptimal search, and its best fill so far.
+		file << (bnb != nullptr) << ' ' << (bnb && bnb->best) << std::endl;
+		if (bnb && bnb->best) {
+			file << bnb->bestScore << std::endl;
+			writeGrid(*bnb->best);
+		}
+
+		file << state.stack.size() << std::endl;
+		for (const auto& frame : state.stack) {
+			int row, column;
+			WordDirection direction;
+			std::tie(row, column, direction) = std::get<0>(frame.word);
+			const auto& characters = std::get<1>(frame.word);
+			file << row << ' ' << column << ' ' << direction << ' '
+				 << std::string(characters.begin(), characters.end()) << ' '
+				 << frame.next << ' ' << frame.boundWithoutWord << ' '
+				 << frame.possibilities.size() << std::endl;
+			for (const auto& possibility : frame.possibilities)
+				file << possibility << std::endl;
+		}
+		file.close();
+		if (!file) return false;
+	}
+	return std::rename(temporaryFilename.c_str(), filename.c_str()) == 0;
+}
+
+bool Crossword::readCheckpoint(const std::string& filename, SearchState* state,
+							   BranchAndBound* bnb) {
+	std::ifstream file(filename);
+	if (!file) return false;
+	std::string header;
+	file >> header;
+	if (header != CHECKPOINT_HEADER) return false;
+	int height, width;
+	file >> height >> width;
+	if (!file || height != height_ || width != width_) return false;
+	auto readGrid = [&](std::vector<std::string>* rows) {
+		rows->resize(height);
+		for (auto& row : *rows) file >> row;
+		return !file.fail();
+	};
+	std::vector<std::string> rows;
+	if (!readGrid(&rows)) return false;
+	file >> state->generator;
+
+	bool optimizing, hasBest;
+	file >> optimizing >> hasBest;
+	if (!file || optimizing != (bnb != nullptr)) return false;
+	// Only a SolveOptimal search has a best fill to restore.
+	if (hasBest && !bnb) return false;
+	if (hasBest) {
+		int bestScore;
+		std::vector<std::string> bestRows;
+		file >> bestScore;
+		if (!readGrid(&bestRows)) return false;
+		std::unique_ptr<Crossword> best(new Crossword(*this));
+		if (!best->restoreGrid(bestRows)) return false;
+		bnb->bestScore = bestScore;
+		bnb->best = std::move(best);
+	}
+	// The frames are checked against the grid, so restore it first.
+	if (!restoreGrid(rows)) return false;
+
+	size_t depth;
+	file >> depth;
+	if (!file) return false;
+	state->stack.clear();
+	for (size_t i = 0; i < depth; i++) {
+		int row, column, direction;
+		std::string characters;
+		size_t possibilityCount;
+		SearchFrame frame;
+		file >> row >> column >> direction >> characters >> frame.next >>
+			frame.boundWithoutWord >> possibilityCount;
+		if (!file) return false;
+		frame.word =
+			MakeWord(row, column, static_cast<WordDirection>(direction),
+					 std::vector<char>(characters.begin(), characters.end()));
+		const auto word = words_.find(std::get<0>(frame.word));
+		if (word == words_.end() ||
+			std::get<1>(word->second).size() != characters.size())
+			return false;
+		frame.possibilities.resize(possibilityCount);
+		for (auto& possibility : frame.possibilities) {
+			file >> possibility;
+			if (possibility.size() != characters.size() ||
+				!AllLetters(possibility))
+				return false;
+		}
+		if (!file || frame.next > possibilityCount) return false;
+		// The word's letters, and the possibility currently placed in it, must
+		// be the ones in the grid.
+		for (size_t j = 0; j < characters.size(); j++) {
+			char inGrid = std::get<0>(
+				grid_[direction == ACROSS ? row : row + j]
+					 [direction == ACROSS ? column + j : column]);
+			if (characters[j] != WILDCARD && characters[j] != inGrid)
+				return false;
+			if (frame.next > 0 &&
+				frame.possibilities[frame.next - 1][j] != inGrid)
+				return false;
+		}
+		state->stack.push_back(std::move(frame));
+	}
+
+	return true;
+}
+
+bool Crossword::restoreGrid(const std::vector<std::string>& rows) {
+	if (rows.size() != static_cast<size_t>(height_)) return false;
+	for (int r = 0; r < height_; r++) {
+		if (rows[r].size() != static_cast<size_t>(width_)) return false;
+		for (int c = 0; c < width_; c++) {
+			char existing = std::get<0>(grid_[r][c]);
+			char value = rows[r][c];
+			if (existing == value) continue;
+			// Only wildcards can be filled in, and only with letters.
+			if (existing != WILDCARD || value < 'A' || value > 'Z')
+				return false;
+			if (!setCharacter(value, r, c)) return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,156 @@
+//
+//  crossword_checkpoint_test.cc
+//  CrosswordCreator
+//
+//  Created by Hunter Knepshield on 10/18/26.
+//  Copyright © 2026 Hunter Knepshield. All rights reserved.
+//
+
+// Tests for checkpointing and resuming Crossword::SolveOptimal searches.
+
+#include "crossword_type.h"
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "test_util.h"
+
+class CheckpointTest {
+   public:
+	/// Resumes a search from a checkpoint taken partway through it, and
+	/// checks that it ends up with the same fill as a search that was never
+	/// interrupted.
+	static void ResumeMatchesUninterrupted() {
+		std::mt19937 generator(2026);
+		std::set<std::string> words;
+		while (words.size() < 120) {
+			std::string word;
+			for (int j = 0; j < 4; j++) word += "AEST"[generator() % 4];
+			words.insert(word);
+		}
+		std::map<std::string, int> scores;
+		for (const auto& word : words)
+			scores[word] = static_cast<int>(generator() % 50) + 1;
+		const std::vector<std::string> rawGrid(4, "....");
+		Wordlist wordlist(words);
+
+		int expectedScore;
+		auto puzzle = Crossword::Create(rawGrid);
+		const auto expected = Crossword::SolveOptimal(
+			*puzzle, wordlist, scores, false, 0, &expectedScore);
+		CHECK(expected.first);
+
+		// Checkpoint before every expansion, and keep a copy of one taken
+		// after a first fill was found.
+		Crossword::Checkpointing checkpointing;
+		checkpointing.filename = "checkpoint_test.checkpoint";
+		checkpointing.intervalSeconds = 0;
+		const std::string partwayFilename = "checkpoint_test.partway";
+		std::atomic<bool> done(false), copied(false);
+		std::thread copier([&]() {
+			while (!done && !copied) {
+				std::ifstream file(checkpointing.filename);
+				std::stringstream contents;
+				contents << file.rdbuf();
+				if (HasBest(contents.str(), rawGrid.size())) {
+					std::ofstream(partwayFilename) << contents.str();
+					copied = true;
+				}
+			}
+		});
+		int score = 0;
+		puzzle = Crossword::Create(rawGrid);
+		const auto checkpointed = Crossword::SolveOptimal(
+			*puzzle, wordlist, scores, false, 0, &score, 0, &checkpointing);
+		done = true;
+		copier.join();
+		CHECK(checkpointed.first && score == expectedScore);
+		CHECK(Rows(checkpointed.second) == Rows(expected.second));
+		// A finished search cleans up after itself.
+		CHECK(!std::ifstream(checkpointing.filename));
+
+		CHECK(copied);
+		CHECK(std::rename(partwayFilename.c_str(),
+						  checkpointing.filename.c_str()) == 0);
+		checkpointing.resume = true;
+		score = 0;
+		puzzle = Crossword::Create(rawGrid);
+		const auto resumed = Crossword::SolveOptimal(
+			*puzzle, wordlist, scores, false, 0, &score, 0, &checkpointing);
+		CHECK(resumed.first && score == expectedScore);
+		CHECK(Rows(resumed.second) == Rows(expected.second));
+		CHECK(!std::ifstream(checkpointing.filename));
+	}
+
+	/// Checks that frames which don't fit the puzzle or its grid are rejected
+	/// instead of being resumed.
+	static void RejectsMalformedFrames() {
+		const std::string filename = "checkpoint_test.checkpoint";
+		// Every checkpoint has "AB" in the top across word, placed by a frame
+		// for that word. Only the first frame fits.
+		const std::vector<std::tuple<std::string, std::vector<std::string>>>
+			frames = {
+				std::make_tuple("..", std::vector<std::string>{"AB", "CD"}),
+				// Longer than the word.
+				std::make_tuple("..........", std::vector<std::string>{"AB"}),
+				// A possibility that's too short, or isn't all letters.
+				std::make_tuple("..", std::vector<std::string>{"AB", "C"}),
+				std::make_tuple("..", std::vector<std::string>{"AB", "c1"}),
+				// Letters that don't agree with the grid.
+				std::make_tuple("C.", std::vector<std::string>{"AB"}),
+				std::make_tuple("..", std::vector<std::string>{"CD", "AB"}),
+			};
+		const auto written = Crossword::Create({"AB", ".."});
+		for (size_t i = 0; i < frames.size(); i++) {
+			const auto& characters = std::get<0>(frames[i]);
+			Crossword::SearchState state;
+			state.stack.push_back(
+				{Crossword::MakeWord(
+					 0, 0, Crossword::ACROSS,
+					 std::vector<char>(characters.begin(), characters.end())),
+				 std::get<1>(frames[i]), 1, 0});
+			CHECK(written->writeCheckpoint(filename, state, nullptr));
+			auto puzzle = Crossword::Create({"..", ".."});
+			Crossword::SearchState restored;
+			CHECK(puzzle->readCheckpoint(filename, &restored, nullptr) ==
+				  (i == 0));
+		}
+		std::remove(filename.c_str());
+	}
+
+   private:
+	/// Returns the rows of puzzle's grid.
+	static std::vector<std::string> Rows(const Crossword& puzzle) {
+		std::vector<std::string> rows;
+		for (const auto& row : puzzle.grid_) {
+			rows.emplace_back();
+			for (const auto& cell : row) rows.back() += std::get<0>(cell);
+		}
+		return rows;
+	}
+
+	/// Returns true if contents is a SolveOptimal checkpoint with a best fill,
+	/// for a grid with the given height.
+	static bool HasBest(const std::string& contents, size_t height) {
+		std::istringstream lines(contents);
+		std::string line;
+		// Skip the header, dimensions, grid and generator.
+		for (size_t i = 0; i < height + 3; i++)
+			if (!std::getline(lines, line)) return false;
+		return std::getline(lines, line) && line == "1 1";
+	}
+};
+
+void RunCheckpointTests() {
+	CheckpointTest::ResumeMatchesUninterrupted();
+	CheckpointTest::RejectsMalformedFrames();
+}
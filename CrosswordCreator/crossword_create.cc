@@ -33,7 +33,13 @@ std::unique_ptr<Crossword> Crossword::Create(int height, int width,
 			// There's already a word that starts here.
 			if (wordMap.find(beginningLocation) != wordMap.end())
 				return nullptr;
-			wordMap[beginningLocation] = word;
+			// Normalize to uppercase.
+			for (auto& character : characters) {
+				if (character >= 'a' && character <= 'z')
+					character = (character - 'a') + 'A';
+			}
+			wordMap[beginningLocation] =
+				std::make_tuple(beginningLocation, characters);
 			std::tie(r, c, direction) = beginningLocation;
 			for (const auto& character : characters) {
 				auto& cell = grid[r][c];
@@ -124,8 +130,9 @@ std::unique_ptr<Crossword> Crossword::Create(
 					beginningR = r;
 					beginningC = c;
 				}
-				// Always record the character for both new and existing words.
-				characters.push_back(rawGrid[r][c]);
+				// Always record the character for both new and existing words,
+				// using the normalized one so the word matches the grid.
+				characters.push_back(std::get<0>(grid[r][c]));
 			} else {
 				if (beginningR != -1) {
 					// We're ending a word, backfill the grid to the left.
@@ -163,8 +170,9 @@ std::unique_ptr<Crossword> Crossword::Create(
 					beginningR = r;
 					beginningC = c;
 				}
-				// Always record the character for both new and existing words.
-				characters.push_back(rawGrid[r][c]);
+				// Always record the character for both new and existing words,
+				// using the normalized one so the word matches the grid.
+				characters.push_back(std::get<0>(grid[r][c]));
 			} else {
 				if (beginningR != -1) {
 					// We're ending a word, backfill the grid to the left.
@@ -11,9 +11,12 @@
 #include "crossword_type.h"
 
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <random>
-#include <regex>
 #include <set>
 #include <string>
 #include <tuple>
@@ -21,168 +24,469 @@
 #include <vector>
 
 std::pair<bool, Crossword> Crossword::Solve(
-	Crossword puzzle, const std::set<std::string>& wordlist,
-	bool randomWordlistSelection, int verbosity) {
-	Word mostConstrained;
-	if (!puzzle.mostConstrained(&mostConstrained)) return {true, puzzle};
+	Crossword puzzle, const Wordlist& wordlist,
+	bool randomWordlistSelection, int verbosity,
+	const Checkpointing* checkpointing) {
+	bool solved = puzzle.solve(wordlist, randomWordlistSelection, verbosity,
+							   nullptr, checkpointing);
+	return {solved, puzzle};
+}
+
+std::pair<bool, Crossword> Crossword::SolveOptimal(
+	Crossword puzzle, const Wordlist& wordlist,
+	const std::map<std::string, int>& scores, bool randomWordlistSelection,
+	int optimalityGap, int* score, int verbosity,
+	const Checkpointing* checkpointing) {
+	BranchAndBound bnb(wordlist, scores, optimalityGap);
+	// With no fill at all there's nothing to optimize.
+	if (!puzzle.upperBound(&bnb)) return {false, puzzle};
+	bnb.rootBound = bnb.bound;
+	puzzle.solve(wordlist, randomWordlistSelection, verbosity, &bnb,
+				 checkpointing);
+	if (!bnb.best) return {false, puzzle};
 
 	switch (verbosity) {
 		case 2:
 		case 1:
-			std::cout << "Attempting to fill in " << mostConstrained
-					  << std::endl;
+			std::cout << "Best fill scored " << bnb.bestScore << " (bound "
+					  << bnb.rootBound << "), ";
+			// Either way the search ended, the best fill is within the gap of
+			// the optimum. It's only known to be optimal without a gap or if
+			// it actually reached the bound.
+			if (optimalityGap == 0 || bnb.bestScore >= bnb.rootBound)
+				std::cout << "proven optimal." << std::endl;
+			else
+				std::cout << "within " << optimalityGap << " of optimal."
+						  << std::endl;
 		default:
 			break;
 	}
+	if (score) *score = bnb.bestScore;
+	return {true, *bnb.best};
+}
 
-	int row, column;
-	WordDirection direction;
-	std::tie(row, column, direction) = std::get<0>(mostConstrained);
-	const std::vector<char>& characters = std::get<1>(mostConstrained);
+std::vector<std::string> Crossword::possibilities(
+	const Word& word, const Wordlist& wordlist) const {
+	const std::vector<char>& characters = std::get<1>(word);
 	// First, throw out any words that:
-	// - Are the wrong length,
-	// - Don't match the current wildcard pattern, or
+	// - Are the wrong length or don't match the current wildcard pattern
+	//   (both handled by the wordlist's cached pattern lookup), or
 	// - Already appear elsewhere in the puzzle.
-	std::vector<std::string> possibilities(wordlist.size());
-	// Easiest filter: length
-	auto wordLength = characters.size();
-	// Next filter: regex
 	std::string pattern(characters.begin(), characters.end());
-	std::regex regex(pattern, std::regex::icase);
-	// Final filter: existing words
+	auto matches = wordlist.matching(pattern);
 	std::set<std::string> existingWords;
-	for (const auto& beginningAndWord : puzzle.words_) {
+	for (const auto& beginningAndWord : words_) {
 		const auto& wordCharacters = std::get<1>(beginningAndWord.second);
 		if (std::find(wordCharacters.begin(), wordCharacters.end(), WILDCARD) ==
 			wordCharacters.end())
 			existingWords.insert(
 				std::string(wordCharacters.begin(), wordCharacters.end()));
 	}
-	auto filterIter = std::copy_if(
-		wordlist.begin(), wordlist.end(), possibilities.begin(),
-		[&](const std::string& s) {
-			return s.size() == wordLength && std::regex_match(s, regex) &&
-				   existingWords.find(s) == existingWords.end();
-		});
-	possibilities.resize(std::distance(possibilities.begin(), filterIter));
+	std::vector<std::string> possibilities;
+	possibilities.reserve(matches->size());
+	for (int id : *matches) {
+		const auto& match = wordlist.word(id);
+		if (existingWords.find(match) == existingWords.end())
+			possibilities.push_back(match);
+	}
+	return possibilities;
+}
 
-	switch (verbosity) {
-		case 2:
-			for (const auto& possibility : possibilities) {
-				std::cout << possibility << std::endl;
-			}
-		case 1:
-			std::cout << "Found " << possibilities.size() << " possibilit"
-					  << (possibilities.size() == 1 ? "y" : "ies")
-					  << " in the word list." << std::endl;
-		default:
-			break;
+Crossword::Share Crossword::BranchAndBound::setShare(const Share& share) {
+	auto it = shares.find(share.beginning);
+	Share replaced = {share.beginning, it != shares.end(), 0};
+	if (replaced.hasShare) {
+		replaced.share = it->second;
+		bound -= it->second;
+	} else {
+		unfillable--;
+	}
+	if (share.hasShare) {
+		bound += share.share;
+		if (replaced.hasShare)
+			it->second = share.share;
+		else
+			shares.emplace(share.beginning, share.share);
+	} else {
+		unfillable++;
+		if (replaced.hasShare) shares.erase(it);
 	}
-	if (possibilities.size() == 0) return {false, puzzle};
+	return replaced;
+}
 
-	if (randomWordlistSelection) {
-		std::random_device randomDevice;
-		std::mt19937 generator(randomDevice());
-		std::shuffle(possibilities.begin(), possibilities.end(), generator);
-	}
-
-	for (const auto& possibility : possibilities) {
-		// Set the word in the puzzle. Undo if we fail anywhere along the way.
-		std::vector<bool> undo(wordLength, false);
-		for (int i = 0; i < wordLength; i++) {
-			if (characters[i] == WILDCARD) {
-				undo[i] = true;
-				bool result = puzzle.setCharacter(
-					possibility[i], direction == ACROSS ? row : row + i,
-					direction == ACROSS ? column + i : column);
-				if (!result) {
-					switch (verbosity) {
-						case 2:
-						case 1:
-							std::cout << "Failed to set character " << i + 1
-									  << " of '" << possibility
-									  << "' to fill in " << mostConstrained
-									  << std::endl;
-							std::cout << puzzle << std::endl;
-						default:
-							break;
-					}
-					goto possibilityFailed;
-				}
-				// If we just completed a crossing word, make sure that it's
-				// valid too.
-				const auto& modifiedCell =
-					puzzle.grid_[direction == ACROSS ? row : row + i]
+bool Crossword::upperBound(BranchAndBound* bnb) const {
+	// Start with no word having a share, then give each one its share.
+	bnb->bound = 0;
+	bnb->shares.clear();
+	bnb->unfillable = static_cast<int>(words_.size());
+	for (const auto& beginningAndWord : words_) {
+		Share share = {beginningAndWord.first, false, 0};
+		share.hasShare = shareOf(beginningAndWord.second, bnb, &share.share);
+		bnb->setShare(share);
+	}
+	return bnb->unfillable == 0;
+}
+
+bool Crossword::shareOf(const Word& word, const BranchAndBound* bnb,
+						int* out) const {
+	const auto& characters = std::get<1>(word);
+	std::string pattern(characters.begin(), characters.end());
+	if (std::find(characters.begin(), characters.end(), WILDCARD) ==
+		characters.end()) {
+		*out = bnb->scoreOf(pattern);
+		return true;
+	}
+	return bnb->bestScoreMatching(pattern, out);
+}
+
+void Crossword::reboundAround(const Word& word, BranchAndBound* bnb,
+							  std::vector<Share>* replaced) const {
+	auto rebound = [&](const WordBeginning& beginning) {
+		Share share = {beginning, false, 0};
+		share.hasShare = shareOf(words_.at(beginning), bnb, &share.share);
+		Share old = bnb->setShare(share);
+		if (replaced) replaced->push_back(old);
+	};
+
+	int row, column;
+	WordDirection direction;
+	std::tie(row, column, direction) = std::get<0>(word);
+	rebound(std::get<0>(word));
+	// Only the words crossing a wildcard of word can have changed.
+	const std::vector<char>& characters = std::get<1>(word);
+	for (size_t i = 0; i < characters.size(); i++) {
+		if (characters[i] != WILDCARD) continue;
+		const auto& cell = grid_[direction == ACROSS ? row : row + i]
 								[direction == ACROSS ? column + i : column];
-				const auto& crossingWordBeginning =
-					direction == ACROSS ? std::get<2>(modifiedCell)
-										: std::get<1>(modifiedCell);
-				const auto& crossingWord = puzzle.words_[crossingWordBeginning];
-				const auto& crossingCharacters = std::get<1>(crossingWord);
-				if (std::find(crossingCharacters.begin(),
-							  crossingCharacters.end(),
-							  WILDCARD) == crossingCharacters.end()) {
-					// No wildcards, so we've just completed this word.
-					std::string crossingString(crossingCharacters.begin(),
-											   crossingCharacters.end());
-					if (wordlist.find(crossingString) == wordlist.end()) {
-						// We generated an invalid word.
-						switch (verbosity) {
-							case 2:
-							case 1:
-								std::cout
-									<< "Failed to set word " << possibility
-									<< " because it broke the word crossing at "
-									   "character "
-									<< i + 1 << " ('" << crossingString << "')"
-									<< std::endl;
-								std::cout << puzzle << std::endl;
-							default:
-								break;
-						}
-						goto possibilityFailed;
-					}
+		const auto& crossingWordBeginning =
+			direction == ACROSS ? std::get<2>(cell) : std::get<1>(cell);
+		if (crossingWordBeginning != INVALID_ACROSS &&
+			crossingWordBeginning != INVALID_DOWN)
+			rebound(crossingWordBeginning);
+	}
+}
+
+bool Crossword::duplicated(const WordBeginning& beginning) const {
+	const auto& characters = std::get<1>(words_.at(beginning));
+	if (std::find(characters.begin(), characters.end(), WILDCARD) !=
+		characters.end())
+		return false;
+	for (const auto& beginningAndWord : words_) {
+		if (beginningAndWord.first != beginning &&
+			std::get<1>(beginningAndWord.second) == characters)
+			return true;
+	}
+	return false;
+}
+
+bool Crossword::placeWord(const Word& word, const std::string& possibility,
+						  const Wordlist& wordlist,
+						  int verbosity) {
+	int row, column;
+	WordDirection direction;
+	std::tie(row, column, direction) = std::get<0>(word);
+	const std::vector<char>& characters = std::get<1>(word);
+	for (size_t i = 0; i < characters.size(); i++) {
+		// If this isn't a wildcard, we're guaranteed a match of characters[i]
+		// and possibility[i] because of the filtering done in possibilities.
+		if (characters[i] != WILDCARD) continue;
+		bool result = setCharacter(possibility[i],
+								   direction == ACROSS ? row : row + i,
+								   direction == ACROSS ? column + i : column);
+		if (!result) {
+			switch (verbosity) {
+				case 2:
+				case 1:
+					std::cout << "Failed to set character " << i + 1 << " of '"
+							  << possibility << "' to fill in " << word
+							  << std::endl;
+					std::cout << *this << std::endl;
+				default:
+					break;
+			}
+			return false;
+		}
+		// If we just completed a crossing word, make sure that it's valid too.
+		const auto& modifiedCell =
+			grid_[direction == ACROSS ? row : row + i]
+				 [direction == ACROSS ? column + i : column];
+		const auto& crossingWordBeginning = direction == ACROSS
+												? std::get<2>(modifiedCell)
+												: std::get<1>(modifiedCell);
+		const auto& crossingWord = words_[crossingWordBeginning];
+		const auto& crossingCharacters = std::get<1>(crossingWord);
+		if (std::find(crossingCharacters.begin(), crossingCharacters.end(),
+					  WILDCARD) == crossingCharacters.end()) {
+			// No wildcards, so we've just completed this word.
+			std::string crossingString(crossingCharacters.begin(),
+									   crossingCharacters.end());
+			if (!wordlist.contains(crossingString)) {
+				// We generated an invalid word.
+				switch (verbosity) {
+					case 2:
+					case 1:
+						std::cout << "Failed to set word " << possibility
+								  << " because it broke the word crossing at "
+									 "character "
+								  << i + 1 << " ('" << crossingString << "')"
+								  << std::endl;
+						std::cout << *this << std::endl;
+					default:
+						break;
 				}
+				return false;
 			}
-			// If this isn't a wildcard, we're guaranteed a match of
-			// characters[i] and possibility[i] because of the filtering that's
-			// done above.
 		}
+	}
+	// Only now that every character is set can we tell whether a crossing word
+	// we completed repeats another word, including the one we just placed.
+	for (size_t i = 0; i < characters.size(); i++) {
+		if (characters[i] != WILDCARD) continue;
+		const auto& modifiedCell =
+			grid_[direction == ACROSS ? row : row + i]
+				 [direction == ACROSS ? column + i : column];
+		const auto& crossingWordBeginning = direction == ACROSS
+												? std::get<2>(modifiedCell)
+												: std::get<1>(modifiedCell);
+		if (crossingWordBeginning == INVALID_ACROSS ||
+			crossingWordBeginning == INVALID_DOWN ||
+			!duplicated(crossingWordBeginning))
+			continue;
 		switch (verbosity) {
 			case 2:
 			case 1:
-				std::cout << "Used '" << possibility << "'" << std::endl;
-				std::cout << puzzle << std::endl;
+				std::cout << "Failed to set word " << possibility
+						  << " because the word crossing at character " << i + 1
+						  << " already appears in the puzzle" << std::endl;
+				std::cout << *this << std::endl;
 			default:
 				break;
 		}
-		// We've successfully set every character for this possibility. Recurse.
-		{
-			// Inner scope to prevent issues with the compiler complaining about
-			// initialization being skipped by the goto.
-			const auto& solvedWithPuzzle =
-				Solve(puzzle, wordlist, randomWordlistSelection, verbosity);
-			if (solvedWithPuzzle.first) return solvedWithPuzzle;
-		}
-	possibilityFailed:
-		// Undo everything in this word that used to be a wildcard.
-		for (int i = 0; i < wordLength; i++) {
-			if (undo[i])
-				puzzle.clearCharacter(
-					direction == ACROSS ? row : row + i,
-					direction == ACROSS ? column + i : column);
+		return false;
+	}
+	switch (verbosity) {
+		case 2:
+		case 1:
+			std::cout << "Used '" << possibility << "'" << std::endl;
+			std::cout << *this << std::endl;
+		default:
+			break;
+	}
+	return true;
+}
+
+void Crossword::unplaceWord(const Word& word) {
+	int row, column;
+	WordDirection direction;
+	std::tie(row, column, direction) = std::get<0>(word);
+	const std::vector<char>& characters = std::get<1>(word);
+	// Undo everything in this word that used to be a wildcard.
+	for (size_t i = 0; i < characters.size(); i++) {
+		if (characters[i] == WILDCARD)
+			clearCharacter(direction == ACROSS ? row : row + i,
+						   direction == ACROSS ? column + i : column);
+	}
+}
+
+bool Crossword::solve(const Wordlist& wordlist, bool randomWordlistSelection,
+					  int verbosity, BranchAndBound* bnb,
+					  const Checkpointing* checkpointing) {
+	SearchState state;
+	if (checkpointing && checkpointing->resume) {
+		if (!readCheckpoint(checkpointing->filename, &state, bnb)) {
+			std::cerr << "Failed to resume from checkpoint '"
+					  << checkpointing->filename << "'." << std::endl;
+			return false;
 		}
 		switch (verbosity) {
 			case 2:
 			case 1:
-				std::cout << "Failed to use '" << possibility << "' to fill in "
-						  << mostConstrained << std::endl;
-				std::cout << "Reverted to previous puzzle state:" << std::endl;
-				std::cout << puzzle << std::endl;
+				std::cout << "Resumed from checkpoint at depth "
+						  << state.stack.size() << ":" << std::endl;
+				std::cout << *this << std::endl;
 			default:
 				break;
 		}
+	} else {
+		std::random_device randomDevice;
+		state.generator.seed(randomDevice());
+	}
+	auto& stack = state.stack;
+	// From here on the bound is only updated for the words that change.
+	if (bnb) upperBound(bnb);
+	std::chrono::seconds checkpointInterval(
+		checkpointing ? checkpointing->intervalSeconds : 0);
+	auto nextCheckpoint = std::chrono::steady_clock::now() + checkpointInterval;
+
+	// Each iteration expands the node for the current grid, then advances the
+	// deepest word that still has possibilities left, backtracking as needed.
+	// Checkpoints are only taken right before an expansion, which is also
+	// where a resumed search starts.
+	bool stop = false;
+	while (true) {
+		if (checkpointing &&
+			std::chrono::steady_clock::now() >= nextCheckpoint) {
+			if (writeCheckpoint(checkpointing->filename, state, bnb)) {
+				switch (verbosity) {
+					case 2:
+					case 1:
+						std::cout << "Wrote checkpoint to '"
+								  << checkpointing->filename << "'."
+								  << std::endl;
+					default:
+						break;
+				}
+			} else {
+				std::cerr << "Failed to write checkpoint to '"
+						  << checkpointing->filename << "'." << std::endl;
+			}
+			nextCheckpoint =
+				std::chrono::steady_clock::now() + checkpointInterval;
+		}
+
+		// SolveOptimal can tell early that some word has no possibilities
+		// left, in which case there's no fill below this node.
+		int bound = bnb ? bnb->bound : 0;
+		bool feasible = !bnb || bnb->unfillable == 0;
+		Word mostConstrained;
+		if (!this->mostConstrained(&mostConstrained)) {
+			if (!bnb) {
+				stop = true;
+				break;
+			}
+			// Every word is complete, so the bound is exactly this fill's
+			// score.
+			if (!bnb->best || bound > bnb->bestScore) {
+				switch (verbosity) {
+					case 2:
+					case 1:
+						std::cout << "Found a fill scoring " << bound
+								  << std::endl;
+					default:
+						break;
+				}
+				bnb->bestScore = bound;
+				bnb->best.reset(new Crossword(*this));
+			}
+			if (bnb->prunable(bnb->rootBound)) {
+				stop = true;
+				break;
+			}
+		} else if (feasible && (!bnb || !bnb->prunable(bound))) {
+			switch (verbosity) {
+				case 2:
+				case 1:
+					std::cout << "Attempting to fill in " << mostConstrained
+							  << std::endl;
+				default:
+					break;
+			}
+
+			auto possibilities =
+				this->possibilities(mostConstrained, wordlist);
+			switch (verbosity) {
+				case 2:
+					for (const auto& possibility : possibilities) {
+						std::cout << possibility << std::endl;
+					}
+				case 1:
+					std::cout << "Found " << possibilities.size()
+							  << " possibilit"
+							  << (possibilities.size() == 1 ? "y" : "ies")
+							  << " in the word list." << std::endl;
+				default:
+					break;
+			}
+
+			if (randomWordlistSelection) {
+				std::shuffle(possibilities.begin(), possibilities.end(),
+							 state.generator);
+			}
+			// The bound on any fill using a given possibility, not counting
+			// what it does to crossing words.
+			int boundWithoutWord = 0;
+			if (bnb) {
+				boundWithoutWord =
+					bound - bnb->shares.at(std::get<0>(mostConstrained));
+				// Score each possibility once, dropping the ones that can't
+				// beat the best fill anyway, and try the best words first so
+				// that the rest can be cut off as soon as one of them can't.
+				std::vector<std::pair<int, std::string>> scored;
+				for (auto& possibility : possibilities) {
+					int score = bnb->scoreOf(possibility);
+					if (!bnb->prunable(boundWithoutWord + score))
+						scored.emplace_back(score, std::move(possibility));
+				}
+				std::stable_sort(scored.begin(), scored.end(),
+								 [](const std::pair<int, std::string>& a,
+									const std::pair<int, std::string>& b) {
+									 return a.first > b.first;
+								 });
+				possibilities.clear();
+				for (auto& scoreAndPossibility : scored)
+					possibilities.push_back(
+						std::move(scoreAndPossibility.second));
+			}
+			stack.push_back({mostConstrained, std::move(possibilities), 0,
+							 boundWithoutWord});
+		}
+
+		bool placed = false, placementFailed = false;
+		while (!placed && !stack.empty()) {
+			auto& frame = stack.back();
+			if (frame.next > 0) {
+				unplaceWord(frame.word);
+				// The bound only follows successful placements, so undoing a
+				// failed one leaves it as it was.
+				if (bnb && !placementFailed) {
+					auto& replaced = frame.replacedShares;
+					if (replaced.empty()) {
+						// Resumed from a checkpoint, so work them out again.
+						reboundAround(frame.word, bnb, nullptr);
+					} else {
+						for (auto it = replaced.rbegin(); it != replaced.rend();
+							 ++it)
+							bnb->setShare(*it);
+						replaced.clear();
+					}
+				}
+				switch (verbosity) {
+					case 2:
+					case 1:
+						std::cout << "Failed to use '"
+								  << frame.possibilities[frame.next - 1]
+								  << "' to fill in " << frame.word << std::endl;
+						std::cout << "Reverted to previous puzzle state:"
+								  << std::endl;
+						std::cout << *this << std::endl;
+					default:
+						break;
+				}
+				placementFailed = false;
+			}
+			if (frame.next == frame.possibilities.size() ||
+				(bnb && bnb->prunable(
+							frame.boundWithoutWord +
+							bnb->scoreOf(frame.possibilities[frame.next])))) {
+				// We've exhausted all possibilities at this level, backtrack.
+				stack.pop_back();
+				continue;
+			}
+			placed = placeWord(frame.word, frame.possibilities[frame.next++],
+							   wordlist, verbosity);
+			placementFailed = !placed;
+			if (bnb && placed)
+				reboundAround(frame.word, bnb, &frame.replacedShares);
+		}
+		if (!placed) break;
+	}
+
+	// The search is over one way or another, so the checkpoint is stale. So
+	// is any temporary file left behind by a write that got killed midway.
+	if (checkpointing) {
+		std::remove(checkpointing->filename.c_str());
+		std::remove(
+			temporaryCheckpointFilename(checkpointing->filename).c_str());
 	}
-	// We've exhausted all possibilities at this level, backtrack.
-	return {false, puzzle};
+	return stop;
 }
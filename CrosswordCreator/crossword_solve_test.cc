@@ -0,0 +1,136 @@
+//
+//  crossword_solve_test.cc
+//  CrosswordCreator
+//
+//  Created by Hunter Knepshield on 10/18/26.
+//  Copyright © 2026 Hunter Knepshield. All rights reserved.
+//
+
+// Tests for Crossword::SolveOptimal, comparing it against a brute-force search
+// over every fill of small random puzzles.
+
+#include "crossword_type.h"
+
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "test_util.h"
+
+class CrosswordTest {
+   public:
+	/// Returns the rows of puzzle's grid.
+	static std::vector<std::string> Rows(const Crossword& puzzle) {
+		std::vector<std::string> rows;
+		for (const auto& row : puzzle.grid_) {
+			rows.emplace_back();
+			for (const auto& cell : row) rows.back() += std::get<0>(cell);
+		}
+		return rows;
+	}
+
+	/// Compares SolveOptimal with a brute-force search on random 3x3 puzzles,
+	/// some with a letter already filled in, and with scores that may be
+	/// negative.
+	static void SolveOptimalMatchesBruteForce() {
+		std::mt19937 generator(2026);
+		for (int instance = 0; instance < 100; instance++) {
+			std::set<std::string> words;
+			for (int i = 0; i < 14; i++) {
+				std::string word;
+				for (int j = 0; j < 3; j++) word += "ABC"[generator() % 3];
+				words.insert(word);
+			}
+			std::map<std::string, int> scores;
+			for (const auto& word : words)
+				scores[word] = static_cast<int>(generator() % 16) - 5;
+			std::vector<std::string> rawGrid(3, "...");
+			if (instance % 3 == 0) {
+				auto& row = rawGrid[generator() % 3];
+				row[generator() % 3] = "abc"[generator() % 3];
+			}
+
+			int best;
+			bool fillable = BruteForce(words, scores, rawGrid, &best);
+			Wordlist wordlist(words);
+			for (int gap : {0, 5}) {
+				auto puzzle = Crossword::Create(rawGrid);
+				CHECK(puzzle);
+				int score = 0;
+				const auto& result = Crossword::SolveOptimal(
+					*puzzle, wordlist, scores, false, gap, &score);
+				CHECK(result.first == fillable);
+				if (!fillable) continue;
+				CHECK(score <= best && score >= best - gap);
+				if (gap == 0) CHECK(score == best);
+				// The fill itself has to be valid and actually score that.
+				int fillScore;
+				CHECK(ScoreFill(Rows(result.second), words, scores, rawGrid,
+								&fillScore));
+				CHECK(fillScore == score);
+			}
+		}
+	}
+
+   private:
+	/// Returns the words of a 3x3 fill, across then down.
+	static std::vector<std::string> WordsOf(
+		const std::vector<std::string>& rows) {
+		std::vector<std::string> fillWords(rows);
+		for (int c = 0; c < 3; c++)
+			fillWords.push_back({rows[0][c], rows[1][c], rows[2][c]});
+		return fillWords;
+	}
+
+	/// Checks that rows is a fill of rawGrid using distinct words from words,
+	/// and if so finds its total score.
+	static bool ScoreFill(const std::vector<std::string>& rows,
+						  const std::set<std::string>& words,
+						  const std::map<std::string, int>& scores,
+						  const std::vector<std::string>& rawGrid, int* out) {
+		for (int r = 0; r < 3; r++) {
+			for (int c = 0; c < 3; c++) {
+				char expected = rawGrid[r][c];
+				if (expected != '.' && rows[r][c] != expected - 'a' + 'A')
+					return false;
+			}
+		}
+		const auto fillWords = WordsOf(rows);
+		if (std::set<std::string>(fillWords.begin(), fillWords.end()).size() !=
+			fillWords.size())
+			return false;
+		*out = 0;
+		for (const auto& word : fillWords) {
+			if (words.find(word) == words.end()) return false;
+			*out += scores.at(word);
+		}
+		return true;
+	}
+
+	/// Finds the best score of any fill of rawGrid by trying every
+	/// combination of across words. Returns false if there's no fill.
+	static bool BruteForce(const std::set<std::string>& words,
+						   const std::map<std::string, int>& scores,
+						   const std::vector<std::string>& rawGrid, int* out) {
+		bool found = false;
+		for (const auto& first : words) {
+			for (const auto& second : words) {
+				for (const auto& third : words) {
+					int score;
+					if (!ScoreFill({first, second, third}, words, scores,
+								   rawGrid, &score))
+						continue;
+					if (!found || score > *out) *out = score;
+					found = true;
+				}
+			}
+		}
+		return found;
+	}
+};
+
+void RunSolveTests() { CrosswordTest::SolveOptimalMatchesBruteForce(); }
@@ -18,7 +18,7 @@
 #include <tuple>
 #include <vector>
 
-const char Crossword::WILDCARD = '.';
+const char Crossword::WILDCARD = Wordlist::WILDCARD;
 const char Crossword::BLACK_SQUARE = '_';
 const Crossword::WordBeginning Crossword::INVALID_ACROSS = {-1, -1, ACROSS};
 const Crossword::WordBeginning Crossword::INVALID_DOWN = {-1, -1, DOWN};
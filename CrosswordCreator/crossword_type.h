@@ -12,12 +12,15 @@
 #include <iostream>
 #include <map>
 #include <memory>
+#include <random>
 #include <set>
 #include <string>
 #include <tuple>
 #include <utility>
 #include <vector>
 
+#include "wordlist.h"
+
 /// A representation of a crossword puzzle.
 class Crossword {
    public:
@@ -48,6 +51,19 @@ class Crossword {
 							   characters);
 	}
 
+	/// Settings for periodically saving an in-progress search to disk so that
+	/// it can be picked back up if the process is killed.
+	struct Checkpointing {
+		/// Where checkpoints are written. The file is replaced atomically and
+		/// removed once the search finishes.
+		std::string filename;
+		/// How often to write a checkpoint, in seconds.
+		int intervalSeconds = 60;
+		/// If true, continues the search saved in filename instead of starting
+		/// a new one. The puzzle and wordlist must match the original search.
+		bool resume = false;
+	};
+
 	/// Takes a list of words, copies them into the instance and generates a
 	/// grid from the words.
 	static std::unique_ptr<Crossword> Create(int height, int width,
@@ -59,8 +75,19 @@ class Crossword {
 	/// Takes a partially solved instance and uses a heuristic that attempts to
 	/// fill in the most-constrained word first using the supplied word list.
 	static std::pair<bool, Crossword> Solve(
-		Crossword puzzle, const std::set<std::string>& wordlist,
-		bool randomWordlistSelection, int verbosity = 0);
+		Crossword puzzle, const Wordlist& wordlist,
+		bool randomWordlistSelection, int verbosity = 0,
+		const Checkpointing* checkpointing = nullptr);
+	/// Like Solve, but keeps searching for the fill with the highest total word
+	/// score according to the supplied scores (words without a score are worth
+	/// 0). Subtrees that can't beat the best fill found so far by more than
+	/// optimalityGap are pruned, so with a gap of 0 the result is optimal. If
+	/// score is non-null, the returned fill's total score is written there.
+	static std::pair<bool, Crossword> SolveOptimal(
+		Crossword puzzle, const Wordlist& wordlist,
+		const std::map<std::string, int>& scores, bool randomWordlistSelection,
+		int optimalityGap, int* score, int verbosity = 0,
+		const Checkpointing* checkpointing = nullptr);
 
 	/// Tells this instance to dump its entire contents, including words, the
 	/// next time it is sent to an output stream.
@@ -72,10 +99,96 @@ class Crossword {
 	friend std::ostream& operator<<(std::ostream& os, const Crossword& cw);
 
    private:
+	friend class CheckpointTest;
+	friend class CrosswordTest;
+
 	/// An intermediate value that is the default for a not-yet-populated grid.
 	/// Should never appear in a valid Crossword instance.
 	static const Cell DEFAULT_CELL;
 
+	/// A word's share of SolveOptimal's bound: its score if it's complete,
+	/// otherwise the best score of any word matching it. hasShare is false if
+	/// no word matches it.
+	struct Share {
+		WordBeginning beginning;
+		bool hasShare;
+		int share;
+	};
+
+	/// Bookkeeping for SolveOptimal's branch-and-bound search.
+	struct BranchAndBound {
+		BranchAndBound(const Wordlist& wordlist,
+					   const std::map<std::string, int>& scores,
+					   int optimalityGap)
+			: wordlist(wordlist),
+			  scores(scores),
+			  scoresId(wordlist.newScoresId()),
+			  optimalityGap(optimalityGap) {}
+
+		/// Returns the score of a completed word.
+		int scoreOf(const std::string& word) const {
+			auto it = scores.find(word);
+			return it == scores.end() ? 0 : it->second;
+		}
+		/// Finds the highest score of any word in the wordlist matching
+		/// pattern. Returns false if no word matches it at all.
+		bool bestScoreMatching(const std::string& pattern, int* out) const {
+			return wordlist.bestScore(pattern, scores, scoresId, out);
+		}
+		/// Returns true if a subtree bounded above by bound can't improve on
+		/// the best fill found so far by more than the optimality gap.
+		bool prunable(int bound) const {
+			return best && bound <= bestScore + optimalityGap;
+		}
+		/// Replaces a word's share, updating bound and unfillable to match.
+		/// Returns the share it replaced.
+		Share setShare(const Share& share);
+
+		const Wordlist& wordlist;
+		const std::map<std::string, int>& scores;
+		/// What bestScoreMatching results are cached under in the wordlist.
+		const size_t scoresId;
+		const int optimalityGap;
+		/// The upper bound of the unfilled puzzle. Once the best fill is within
+		/// the gap of this, there's no point in searching any further.
+		int rootBound = 0;
+		/// The upper bound of the grid as it currently stands, kept up to date
+		/// as words are placed and unplaced.
+		int bound = 0;
+		/// Each word's share of bound. Words without one are counted in
+		/// unfillable instead.
+		std::map<WordBeginning, int> shares;
+		/// How many words have no share. Unless this is 0, the grid as it
+		/// currently stands has no fill.
+		int unfillable = 0;
+		int bestScore = 0;
+		std::unique_ptr<Crossword> best;
+	};
+
+	/// One level of the search: a word being filled in and the possibilities
+	/// for it.
+	struct SearchFrame {
+		/// The word as it was before any possibility was placed in it.
+		Word word;
+		std::vector<std::string> possibilities;
+		/// The index of the next possibility to try. The one before it is
+		/// currently placed in the grid.
+		size_t next;
+		/// SolveOptimal only: the bound on any fill at this level, not counting
+		/// the word being filled in.
+		int boundWithoutWord;
+		/// SolveOptimal only: the shares that placing the current possibility
+		/// replaced, so that unplacing it can put them back. These aren't
+		/// checkpointed, so a resumed frame starts without them.
+		std::vector<Share> replacedShares;
+	};
+	/// Everything besides the grid itself that's needed to pick a search back
+	/// up from where it left off.
+	struct SearchState {
+		std::vector<SearchFrame> stack;
+		std::mt19937 generator;
+	};
+
 	Crossword(int height, int width, const std::map<WordBeginning, Word>& words,
 			  const std::vector<std::vector<Cell>>& grid)
 		: height_(height), width_(width), words_(words), grid_(grid) {}
@@ -83,6 +196,61 @@ class Crossword {
 	/// Finds the word that is the most constrained in the given puzzle. If no
 	/// unconstrained words are present in the puzzle, returns false.
 	bool mostConstrained(Word* out);
+	/// Returns every word in the wordlist that could fill in the given word
+	/// without duplicating a word that's already in the puzzle.
+	std::vector<std::string> possibilities(
+		const Word& word, const Wordlist& wordlist) const;
+	/// Finds an optimistic bound on the total score of any fill of this
+	/// puzzle: completed words count their actual score, incomplete words count
+	/// the best score of any word matching their current pattern. Computes
+	/// bnb's bound, shares and unfillable from scratch. Returns false if some
+	/// incomplete word has no matches, i.e. there is no fill at all.
+	bool upperBound(BranchAndBound* bnb) const;
+	/// Finds word's share of the upper bound. Returns false if it has none.
+	bool shareOf(const Word& word, const BranchAndBound* bnb, int* out) const;
+	/// Updates bnb's bound after word has been placed or unplaced, by
+	/// recomputing the shares of word and of the words crossing its wildcards.
+	/// If replaced is non-null, the shares that were replaced are added to it.
+	void reboundAround(const Word& word, BranchAndBound* bnb,
+					   std::vector<Share>* replaced) const;
+	/// Returns true if the word starting at beginning is complete and is the
+	/// same as another word in the puzzle.
+	bool duplicated(const WordBeginning& beginning) const;
+	/// Fills in the wildcards of word with possibility. Returns false if that
+	/// conflicts with the grid or completes a crossing word that isn't in the
+	/// wordlist, in which case the caller must unplace the word.
+	bool placeWord(const Word& word, const std::string& possibility,
+				   const Wordlist& wordlist, int verbosity);
+	/// Resets every character of word that was a wildcard back to one.
+	void unplaceWord(const Word& word);
+	/// The backtracking search behind Solve and SolveOptimal. The search stack
+	/// is kept explicitly so that it can be checkpointed. Returns true if the
+	/// search should stop, otherwise the search space was exhausted. Without
+	/// bnb, the search stops at the first fill and this instance holds it. With
+	/// bnb, every fill is recorded in bnb and the search only stops once the
+	/// best one is within the gap.
+	bool solve(const Wordlist& wordlist, bool randomWordlistSelection,
+			   int verbosity, BranchAndBound* bnb,
+			   const Checkpointing* checkpointing);
+	/// Atomically writes the current grid, search state and best fill so far
+	/// (if any) to filename. Returns false if the file couldn't be written.
+	bool writeCheckpoint(const std::string& filename, const SearchState& state,
+						 const BranchAndBound* bnb) const;
+	/// Returns where writeCheckpoint stages a checkpoint before renaming it
+	/// over filename.
+	static std::string temporaryCheckpointFilename(
+		const std::string& filename) {
+		return filename + ".tmp";
+	}
+	/// Restores a checkpoint written by writeCheckpoint for this puzzle.
+	/// Returns false if the file is missing, malformed or for another puzzle,
+	/// including if any frame's word or possibilities don't fit the grid. The
+	/// grid may be left partly restored in that case.
+	bool readCheckpoint(const std::string& filename, SearchState* state,
+						BranchAndBound* bnb);
+	/// Fills in this instance's wildcards to match rows. Returns false if rows
+	/// don't match the dimensions and existing characters of the grid.
+	bool restoreGrid(const std::vector<std::string>& rows);
 
 	/// Sets the specified cell in the board to be the specified character.
 	/// Returns false if the operation failed for some reason. Normalizes all
@@ -96,7 +264,7 @@ class Crossword {
 	int height_, width_;
 	std::map<WordBeginning, Word> words_;
 	std::vector<std::vector<Cell>> grid_;
-	mutable bool printEverything_;
+	mutable bool printEverything_ = false;
 };
 
 // Custom stream operators to make debugging prettier.
@@ -6,8 +6,12 @@
 //  Copyright © 2017 Hunter Knepshield. All rights reserved.
 //
 
+#include <algorithm>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -23,8 +27,38 @@ int verbosity = 1;
 // Randomness settings. If false, the first valid word from the wordlist is
 // inserted, resulting in a puzzle that has lots of 'A' words.
 bool randomWordlistSelection = true;
+// Optimization settings. If true, searches for the fill with the highest total
+// word score instead of stopping at the first fill. Scores are read from
+// wordlist entries of the form WORD;SCORE, and the search stops early once the
+// best fill is provably within optimalityGap of the optimum.
+bool optimizeFill = false;
+int optimalityGap = 0;
+// Checkpoint settings. While solving, the search is saved to checkpointFilename
+// every checkpointInterval seconds. Running with --resume (and the same puzzle
+// and wordlist as input) continues from the last checkpoint.
+std::string checkpointFilename = "crossword.checkpoint";
+int checkpointInterval = 60;
+// Pattern cache settings. The maximum number of bytes the wordlist may spend
+// remembering which words match each pattern the search asks about.
+size_t patternCacheBytes = Wordlist::DEFAULT_CACHE_BYTES;
+// Wordlist update settings. While running, lines of the form +WORD or -WORD
+// appended to wordlistUpdatesFilename insert or delete words. Each fill uses
+// the wordlist as it was when that fill started.
+std::string wordlistUpdatesFilename = "wordlist.updates";
+
+int main(int argc, char* argv[]) {
+	Crossword::Checkpointing checkpointing;
+	checkpointing.filename = checkpointFilename;
+	checkpointing.intervalSeconds = checkpointInterval;
+	for (int i = 1; i < argc; i++) {
+		if (std::string(argv[i]) == "--resume") {
+			checkpointing.resume = true;
+		} else {
+			std::cerr << "Unknown option '" << argv[i] << "'." << std::endl;
+			return 1;
+		}
+	}
 
-int main(void) {
 	std::unique_ptr<Crossword> crosswordPtr = nullptr;
 	switch (inputSetting) {
 		case WORDS: {
@@ -110,9 +144,16 @@ int main(void) {
 				  << std::endl;
 	}
 	std::set<std::string> dedupedWordlist;
+	std::map<std::string, int> wordScores;
 	bool skip;
 	for (auto& word : wordlist) {
 		skip = false;
+		int score = 0;
+		auto separator = word.find(';');
+		if (separator != std::string::npos) {
+			score = std::atoi(word.c_str() + separator + 1);
+			word.resize(separator);
+		}
 		for (auto& character : word) {
 			if (character >= 'a' && character <= 'z')
 				character = (character - 'a') + 'A';
@@ -120,21 +161,58 @@ int main(void) {
 		}
 		if (skip) continue;
 		dedupedWordlist.insert(word);
+		if (wordScores.find(word) == wordScores.end())
+			wordScores[word] = score;
+		else
+			wordScores[word] = std::max(wordScores[word], score);
 	}
 	std::cout << "Read " << dedupedWordlist.size()
 			  << " words from the wordlist." << std::endl;
 	std::cout << std::endl;
+	// Searches run against a snapshot, so they're unaffected by any updates to
+	// the live wordlist made while they're running.
+	LiveWordlist liveWordlist(dedupedWordlist, patternCacheBytes);
+	liveWordlist.follow(wordlistUpdatesFilename);
 
 	std::cout << "Initial puzzle:" << std::endl;
 	std::cout << crossword.printEverything() << std::endl;
 
-	const auto& result = Crossword::Solve(crossword, dedupedWordlist,
-										  randomWordlistSelection, verbosity);
-	if (result.first) {
-		std::cout << "Generated a puzzle:" << std::endl;
-		std::cout << result.second.printEverything() << std::endl;
-	} else {
-		std::cout << "Failed to generate a puzzle." << std::endl;
+	while (true) {
+		const auto wordlistSnapshot = liveWordlist.snapshot();
+		int score = 0;
+		const auto& result =
+			optimizeFill
+				? Crossword::SolveOptimal(crossword, *wordlistSnapshot,
+										  wordScores, randomWordlistSelection,
+										  optimalityGap, &score, verbosity,
+										  &checkpointing)
+				: Crossword::Solve(crossword, *wordlistSnapshot,
+								   randomWordlistSelection, verbosity,
+								   &checkpointing);
+		if (result.first) {
+			std::cout << "Generated a puzzle";
+			if (optimizeFill) std::cout << " scoring " << score;
+			std::cout << ":" << std::endl;
+			std::cout << result.second.printEverything() << std::endl;
+		} else {
+			std::cout << "Failed to generate a puzzle." << std::endl;
+		}
+		if (verbosity > 0) {
+			const auto& stats = wordlistSnapshot->cacheStats();
+			auto lookups = stats.hits + stats.misses;
+			std::cout << "Pattern cache: " << stats.hits << " hits, "
+					  << stats.misses << " misses ("
+					  << (lookups ? 100 * stats.hits / lookups : 0)
+					  << "% hit rate), " << stats.entries << " entries using "
+					  << stats.bytes / 1024 << " KiB." << std::endl;
+		}
+
+		// Only the first fill picks up where a checkpoint left off.
+		checkpointing.resume = false;
+		std::cout << "Generate another fill? (y/n)..." << std::endl;
+		std::string answer;
+		if (!(std::cin >> answer) || (answer != "y" && answer != "Y")) break;
+		std::cout << std::endl;
 	}
 
 	return 0;
@@ -0,0 +1,24 @@
+//
+//  test_main.cc
+//  CrosswordCreator
+//
+//  Created by Hunter Knepshield on 10/18/26.
+//  Copyright © 2026 Hunter Knepshield. All rights reserved.
+//
+
+// Runs every test, exiting with an error at the first failed check. Build the
+// CrosswordCreatorTests target, or run this from this directory:
+//   c++ -std=c++14 -pthread -o tests test_main.cc *_test.cc wordlist.cc
+//       crossword_{checkpoint,create,solve,type}.cc && ./tests
+
+#include <iostream>
+
+#include "test_util.h"
+
+int main() {
+	RunWordlistTests();
+	RunSolveTests();
+	RunCheckpointTests();
+	std::cout << "All tests passed." << std::endl;
+	return 0;
+}
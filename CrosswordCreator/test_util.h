@@ -0,0 +1,31 @@
+//
+//  test_util.h
+//  CrosswordCreator
+//
+//  Created by Hunter Knepshield on 10/18/26.
+//  Copyright © 2026 Hunter Knepshield. All rights reserved.
+//
+
+#ifndef test_util_h
+#define test_util_h
+
+#include <cstdlib>
+#include <iostream>
+
+/// Fails the test run if condition is false. Unlike assert, this is checked no
+/// matter how the tests are built.
+#define CHECK(condition)                                                \
+	do {                                                                \
+		if (!(condition)) {                                             \
+			std::cerr << __FILE__ << ":" << __LINE__                    \
+					  << ": check failed: " << #condition << std::endl; \
+			std::exit(1);                                               \
+		}                                                               \
+	} while (false)
+
+/// Entry points for each file of tests, run by test_main.cc.
+void RunWordlistTests();
+void RunCheckpointTests();
+void RunSolveTests();
+
+#endif /* test_util_h */
@@ -0,0 +1,467 @@
+//
+//  wordlist.cc
+//  CrosswordCreator
+//
+//  Created by Hunter Knepshield on 10/18/26.
+//  Copyright © 2026 Hunter Knepshield. All rights reserved.
+//
+
+// This file contains implementations for all Wordlist and LiveWordlist
+// methods.
+
+#include "wordlist.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/// How many delta segments a snapshot may have before it gets compacted.
+const size_t MAX_DELTA_SEGMENTS = 8;
+/// How many tombstones a snapshot may have before it gets compacted.
+const size_t MAX_TOMBSTONES = 1024;
+
+/// Converts word to uppercase, returning false if it isn't made of letters.
+bool normalizeWord(std::string* word) {
+	if (word->empty()) return false;
+	for (auto& character : *word) {
+		if (character >= 'a' && character <= 'z')
+			character = (character - 'a') + 'A';
+		if (character < 'A' || character > 'Z') return false;
+	}
+	return true;
+}
+
+}  // namespace
+
+/// A memory-bounded LRU cache of pattern matches. Entries are keyed by an ID
+/// handed out by the cache as well as the pattern, so segments and snapshots
+/// can all share one budget.
+class Wordlist::PatternCache {
+   public:
+	explicit PatternCache(size_t capacity) : capacity_(capacity) {}
+
+	/// Returns an ID that nothing else has cached matches under.
+	size_t newId();
+	/// Returns the matches cached for pattern under id, or nullptr if there
+	/// aren't any. counted says whether this goes toward the hit and miss
+	/// counts.
+	Matches find(size_t id, const std::string& pattern, bool counted);
+	/// Caches matches for pattern under id and returns them. If they've been
+	/// cached in the meantime, returns the cached matches instead.
+	Matches insert(size_t id, const std::string& pattern, Matches matches);
+	CacheStats stats() const;
+
+   private:
+	typedef std::pair<size_t, std::string> Key;
+	struct KeyHash {
+		size_t operator()(const Key& key) const {
+			return std::hash<std::string>()(key.second) * 31 + key.first;
+		}
+	};
+	/// A cached pattern's matches and its position in the recency list.
+	typedef std::pair<Matches, std::list<Key>::iterator> Entry;
+
+	/// Returns roughly how much memory caching matches under key takes.
+	static size_t cost(const Key& key, const Matches& matches);
+
+	const size_t capacity_;
+	mutable std::mutex mutex_;
+	/// Cached keys, most recently used first.
+	std::list<Key> recency_;
+	std::unordered_map<Key, Entry, KeyHash> entries_;
+	size_t nextId_ = 0, bytes_ = 0, hits_ = 0, misses_ = 0;
+};
+
+/// An immutable, sorted run of words.
+class Wordlist::Segment {
+   public:
+	Segment(const std::set<std::string>& words,
+			std::shared_ptr<PatternCache> cache);
+
+	size_t size() const { return words_.size(); }
+	size_t cacheId() const { return cacheId_; }
+	const std::string& word(int id) const { return words_[id]; }
+	bool contains(const std::string& word) const;
+	/// Returns the segment-local IDs of every word matching pattern, going
+	/// through the cache.
+	Matches matching(const std::string& pattern) const;
+	/// Like matching, but always scans the words and never touches the cache.
+	Matches scan(const std::string& pattern) const;
+
+   private:
+	std::vector<std::string> words_;
+	/// Word IDs grouped by word length, so lookups only scan plausible words.
+	std::map<size_t, std::vector<int>> idsByLength_;
+	std::shared_ptr<PatternCache> cache_;
+	size_t cacheId_;
+};
+
+const size_t Wordlist::DEFAULT_CACHE_BYTES = 64 << 20;
+const char Wordlist::WILDCARD;
+
+Wordlist::Wordlist(const std::set<std::string>& words, size_t cacheBytes)
+	: tombstones_(std::make_shared<std::set<std::string>>()),
+	  cache_(std::make_shared<PatternCache>(cacheBytes)) {
+	segments_.push_back(std::make_shared<Segment>(words, cache_));
+	offsets_.push_back(0);
+	cacheId_ = segments_.front()->cacheId();
+}
+
+Wordlist::Wordlist(const std::vector<std::shared_ptr<const Segment>>& segments,
+				   std::shared_ptr<const std::set<std::string>> tombstones,
+				   std::shared_ptr<PatternCache> cache)
+	: segments_(segments), tombstones_(tombstones), cache_(cache) {
+	int offset = 0;
+	for (const auto& segment : segments_) {
+		offsets_.push_back(offset);
+		offset += segment->size();
+	}
+	// A lone segment's matches are already this snapshot's matches.
+	cacheId_ = segments_.size() == 1 && tombstones_->empty()
+				   ? segments_.front()->cacheId()
+				   : cache_->newId();
+}
+
+const std::string& Wordlist::word(int id) const {
+	auto i = std::upper_bound(offsets_.begin(), offsets_.end(), id) -
+			 offsets_.begin() - 1;
+	return segments_[i]->word(id - offsets_[i]);
+}
+
+bool Wordlist::contains(const std::string& word) const {
+	if (tombstones_->find(word) != tombstones_->end()) return false;
+	for (const auto& segment : segments_)
+		if (segment->contains(word)) return true;
+	return false;
+}
+
+Wordlist::Matches Wordlist::matching(const std::string& pattern) const {
+	return matching(pattern, true);
+}
+
+size_t Wordlist::newScoresId() const { return cache_->newId(); }
+
+bool Wordlist::bestScore(const std::string& pattern, const Scores& scores,
+						 size_t scoresId, int* out) const {
+	// Best scores are cached just like matches, as a list holding the best
+	// score, or nothing if no word matches.
+	auto best = cache_->find(scoresId, pattern, true);
+	if (!best) {
+		auto bestList = std::make_shared<std::vector<int>>();
+		const auto matches = matching(pattern, false);
+		for (int id : *matches) {
+			auto it = scores.find(word(id));
+			int score = it == scores.end() ? 0 : it->second;
+			if (bestList->empty())
+				bestList->push_back(score);
+			else
+				bestList->front() = std::max(bestList->front(), score);
+		}
+		best = cache_->insert(scoresId, pattern, bestList);
+	}
+	if (best->empty()) return false;
+	*out = best->front();
+	return true;
+}
+
+Wordlist::Matches Wordlist::matching(const std::string& pattern,
+									 bool counted) const {
+	auto cached = cache_->find(cacheId_, pattern, counted);
+	if (cached) return cached;
+	if (segments_.size() == 1 && tombstones_->empty())
+		return cache_->insert(cacheId_, pattern,
+							  segments_.front()->scan(pattern));
+
+	// Combine each segment's matches, which are likely cached already since
+	// older snapshots share most of their segments with this one.
+	auto matches = std::make_shared<std::vector<int>>();
+	for (size_t i = 0; i < segments_.size(); i++) {
+		const auto& segment = *segments_[i];
+		auto segmentMatches = segment.matching(pattern);
+		for (int id : *segmentMatches) {
+			if (tombstones_->find(segment.word(id)) == tombstones_->end())
+				matches->push_back(offsets_[i] + id);
+		}
+	}
+	return cache_->insert(cacheId_, pattern, matches);
+}
+
+Wordlist::CacheStats Wordlist::cacheStats() const { return cache_->stats(); }
+
+std::shared_ptr<const Wordlist> Wordlist::withUpdates(
+	const std::vector<std::string>& inserts,
+	const std::vector<std::string>& deletes) const {
+	auto tombstones = std::make_shared<std::set<std::string>>(*tombstones_);
+	auto inSegment = [&](const std::string& word) {
+		for (const auto& segment : segments_)
+			if (segment->contains(word)) return true;
+		return false;
+	};
+	// Insertions first, so a word both inserted and deleted ends up deleted.
+	std::set<std::string> added;
+	for (const auto& word : inserts) {
+		// Bringing back a deleted word just means forgetting its tombstone.
+		if (tombstones->erase(word) == 0 && !inSegment(word))
+			added.insert(word);
+	}
+	for (const auto& word : deletes) {
+		if (added.erase(word) == 0 && inSegment(word))
+			tombstones->insert(word);
+	}
+
+	auto segments = segments_;
+	if (!added.empty())
+		segments.push_back(std::make_shared<Segment>(added, cache_));
+	return std::shared_ptr<const Wordlist>(
+		new Wordlist(segments, tombstones, cache_));
+}
+
+bool Wordlist::needsCompaction() const {
+	return segments_.size() > MAX_DELTA_SEGMENTS + 1 ||
+		   tombstones_->size() > MAX_TOMBSTONES;
+}
+
+std::shared_ptr<const Wordlist::Segment> Wordlist::merged() const {
+	std::set<std::string> words;
+	for (const auto& segment : segments_) {
+		for (size_t id = 0; id < segment->size(); id++) {
+			const auto& word = segment->word(id);
+			if (tombstones_->find(word) == tombstones_->end())
+				words.insert(word);
+		}
+	}
+	return std::make_shared<Segment>(words, cache_);
+}
+
+std::shared_ptr<const Wordlist> Wordlist::rebased(
+	const Wordlist& compacted, std::shared_ptr<const Segment> merged) const {
+	// Updates since compacted was taken only ever appended segments and
+	// changed tombstones. Tombstones that were already there are baked into
+	// merged, so the only ones that still matter are new ones, and any word
+	// whose tombstone has since been cleared needs adding back.
+	const auto& oldTombstones = *compacted.tombstones_;
+	auto tombstones = std::make_shared<std::set<std::string>>();
+	for (const auto& word : *tombstones_) {
+		if (oldTombstones.find(word) == oldTombstones.end())
+			tombstones->insert(word);
+	}
+	std::set<std::string> reinserted;
+	for (const auto& word : oldTombstones) {
+		if (tombstones_->find(word) == tombstones_->end())
+			reinserted.insert(word);
+	}
+
+	std::vector<std::shared_ptr<const Segment>> segments = {merged};
+	if (!reinserted.empty())
+		segments.push_back(std::make_shared<Segment>(reinserted, cache_));
+	segments.insert(segments.end(),
+					segments_.begin() + compacted.segments_.size(),
+					segments_.end());
+	return std::shared_ptr<const Wordlist>(
+		new Wordlist(segments, tombstones, cache_));
+}
+
+size_t Wordlist::PatternCache::newId() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return nextId_++;
+}
+
+Wordlist::Matches Wordlist::PatternCache::find(size_t id,
+											   const std::string& pattern,
+											   bool counted) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto it = entries_.find({id, pattern});
+	if (it == entries_.end()) {
+		if (counted) misses_++;
+		return nullptr;
+	}
+	if (counted) hits_++;
+	// Move the key to the front of the recency list.
+	recency_.splice(recency_.begin(), recency_, it->second.second);
+	return it->second.first;
+}
+
+Wordlist::Matches Wordlist::PatternCache::insert(size_t id,
+												 const std::string& pattern,
+												 Matches matches) {
+	Key key = {id, pattern};
+	size_t entryCost = cost(key, matches);
+	// Don't let one enormous result flush everything else out of the cache.
+	if (entryCost > capacity_) return matches;
+	std::lock_guard<std::mutex> lock(mutex_);
+	// If two threads miss on the same pattern at once, the second one to
+	// finish just gets the first one's result.
+	auto it = entries_.find(key);
+	if (it != entries_.end()) {
+		recency_.splice(recency_.begin(), recency_, it->second.second);
+		return it->second.first;
+	}
+	recency_.push_front(key);
+	entries_[key] = {matches, recency_.begin()};
+	bytes_ += entryCost;
+	// Evict the least recently used entries until we're back under budget.
+	while (bytes_ > capacity_) {
+		auto evicted = entries_.find(recency_.back());
+		bytes_ -= cost(evicted->first, evicted->second.first);
+		entries_.erase(evicted);
+		recency_.pop_back();
+	}
+	return matches;
+}
+
+Wordlist::CacheStats Wordlist::PatternCache::stats() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return {hits_, misses_, entries_.size(), bytes_};
+}
+
+size_t Wordlist::PatternCache::cost(const Key& key, const Matches& matches) {
+	// The key is stored twice (map key and recency list), plus the IDs and a
+	// rough allowance for the node and control block overhead.
+	return 2 * (sizeof(key.first) + key.second.size()) +
+		   matches->size() * sizeof(int) + 128;
+}
+
+Wordlist::Segment::Segment(const std::set<std::string>& words,
+						   std::shared_ptr<PatternCache> cache)
+	: words_(words.begin(), words.end()),
+	  cache_(cache),
+	  cacheId_(cache->newId()) {
+	for (size_t id = 0; id < words_.size(); id++)
+		idsByLength_[words_[id].size()].push_back(id);
+}
+
+bool Wordlist::Segment::contains(const std::string& word) const {
+	return std::binary_search(words_.begin(), words_.end(), word);
+}
+
+Wordlist::Matches Wordlist::Segment::matching(
+	const std::string& pattern) const {
+	auto cached = cache_->find(cacheId_, pattern, false);
+	if (cached) return cached;
+	return cache_->insert(cacheId_, pattern, scan(pattern));
+}
+
+Wordlist::Matches Wordlist::Segment::scan(const std::string& pattern) const {
+	auto matches = std::make_shared<std::vector<int>>();
+	auto lengthIter = idsByLength_.find(pattern.size());
+	if (lengthIter != idsByLength_.end()) {
+		for (int id : lengthIter->second) {
+			const auto& word = words_[id];
+			bool match = true;
+			for (size_t i = 0; i < pattern.size() && match; i++)
+				match = pattern[i] == WILDCARD || pattern[i] == word[i];
+			if (match) matches->push_back(id);
+		}
+	}
+	return matches;
+}
+
+LiveWordlist::LiveWordlist(const std::set<std::string>& words,
+						   size_t cacheBytes)
+	: current_(std::make_shared<Wordlist>(words, cacheBytes)),
+	  compactor_(&LiveWordlist::compact, this) {}
+
+LiveWordlist::~LiveWordlist() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = true;
+	}
+	compactionNeeded_.notify_one();
+	stopRequested_.notify_one();
+	compactor_.join();
+	if (follower_.joinable()) follower_.join();
+}
+
+std::shared_ptr<const Wordlist> LiveWordlist::snapshot() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return current_;
+}
+
+void LiveWordlist::update(const std::vector<std::string>& inserts,
+						  const std::vector<std::string>& deletes) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	current_ = current_->withUpdates(inserts, deletes);
+	if (current_->needsCompaction()) compactionNeeded_.notify_one();
+}
+
+void LiveWordlist::follow(const std::string& filename,
+						  int intervalMilliseconds) {
+	// Apply what's already there up front, so the very next snapshot sees it
+	// rather than whatever the polling thread has gotten to.
+	std::streamoff applied = 0;
+	applyUpdates(filename, &applied);
+	follower_ = std::thread(&LiveWordlist::followUpdates, this, filename,
+							intervalMilliseconds, applied);
+}
+
+void LiveWordlist::compact() {
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (true) {
+		compactionNeeded_.wait(lock, [&]() {
+			return stopping_ || current_->needsCompaction();
+		});
+		if (stopping_) return;
+		// Merge without holding the lock so snapshots and updates can carry on
+		// in the meantime, then graft whatever changed onto the result.
+		auto source = current_;
+		lock.unlock();
+		auto merged = source->merged();
+		lock.lock();
+		current_ = current_->rebased(*source, merged);
+	}
+}
+
+void LiveWordlist::followUpdates(const std::string& filename,
+								 int intervalMilliseconds,
+								 std::streamoff applied) {
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (true) {
+		stopRequested_.wait_for(
+			lock, std::chrono::milliseconds(intervalMilliseconds),
+			[&]() { return stopping_; });
+		if (stopping_) return;
+		lock.unlock();
+		applyUpdates(filename, &applied);
+		lock.lock();
+	}
+}
+
+void LiveWordlist::applyUpdates(const std::string& filename,
+								std::streamoff* applied) {
+	// Whether each word was last inserted (true) or deleted (false), so a
+	// batch ends up the same as applying its lines one at a time.
+	std::map<std::string, bool> changes;
+	std::ifstream file(filename);
+	if (file) {
+		file.seekg(0, std::ios::end);
+		if (file.tellg() < *applied) *applied = 0;
+		file.seekg(*applied);
+		std::string line;
+		// A line without a newline may still be being written, so leave it
+		// for next time.
+		while (std::getline(file, line) && !file.eof()) {
+			*applied = file.tellg();
+			if (!line.empty() && line.back() == '\r') line.pop_back();
+			if (line.empty() || (line[0] != '+' && line[0] != '-')) continue;
+			std::string word = line.substr(1);
+			if (normalizeWord(&word)) changes[word] = line[0] == '+';
+		}
+	}
+	if (changes.empty()) return;
+	std::vector<std::string> inserts, deletes;
+	for (const auto& change : changes)
+		(change.second ? inserts : deletes).push_back(change.first);
+	update(inserts, deletes);
+}
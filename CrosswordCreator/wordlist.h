@@ -0,0 +1,163 @@
+//
+//  wordlist.h
+//  CrosswordCreator
+//
+//  Created by Hunter Knepshield on 10/18/26.
+//  Copyright © 2026 Hunter Knepshield. All rights reserved.
+//
+
+#ifndef wordlist_h
+#define wordlist_h
+
+#include <condition_variable>
+#include <cstddef>
+#include <ios>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// An immutable snapshot of a dictionary of valid words, indexed by ID. The
+/// words live in a base segment plus any delta segments appended by updates,
+/// minus a set of tombstoned (deleted) words. Lookups of every word matching a
+/// pattern go through one memory-bounded LRU cache shared by every segment and
+/// snapshot of the dictionary, which remembers each segment's matches as well
+/// as each snapshot's combined matches and best scores. Snapshots can be shared
+/// by any number of searches and threads.
+class Wordlist {
+   public:
+	/// A list of word IDs, shared between the cache and its users.
+	typedef std::shared_ptr<const std::vector<int>> Matches;
+	/// Scores for some of the words. Words without one are worth 0.
+	typedef std::map<std::string, int> Scores;
+	/// Counters describing how well the pattern cache is doing.
+	struct CacheStats {
+		size_t hits, misses;
+		/// The number of matches and best scores currently cached, and
+		/// roughly how much memory they take up.
+		size_t entries, bytes;
+	};
+	/// How much memory the pattern cache may use by default.
+	static const size_t DEFAULT_CACHE_BYTES;
+	/// The character that matches any letter in a pattern.
+	static const char WILDCARD = '.';
+
+	/// Takes a set of uppercase words. IDs are assigned in sorted order.
+	explicit Wordlist(const std::set<std::string>& words,
+					  size_t cacheBytes = DEFAULT_CACHE_BYTES);
+
+	/// Returns the word with the given ID. IDs are only meaningful within the
+	/// snapshot that handed them out.
+	const std::string& word(int id) const;
+	/// Returns true if word is in the dictionary.
+	bool contains(const std::string& word) const;
+
+	/// Returns the IDs of every word matching pattern, where a wildcard matches
+	/// any letter. Patterns are uppercase, like the words themselves.
+	Matches matching(const std::string& pattern) const;
+	/// Returns an ID to cache bestScore results for one set of scores under.
+	size_t newScoresId() const;
+	/// Finds the highest score of any word matching pattern. Returns false if
+	/// no word matches it at all. Results are cached under scoresId, which must
+	/// come from newScoresId and only ever be used with this snapshot and the
+	/// same scores.
+	bool bestScore(const std::string& pattern, const Scores& scores,
+				   size_t scoresId, int* out) const;
+	/// Returns the pattern cache's counters, which are shared by every
+	/// snapshot of the dictionary. Each call to matching or bestScore counts
+	/// as exactly one hit or miss.
+	CacheStats cacheStats() const;
+
+   private:
+	class PatternCache;
+	class Segment;
+	friend class LiveWordlist;
+	friend class WordlistTest;
+
+	Wordlist(const std::vector<std::shared_ptr<const Segment>>& segments,
+			 std::shared_ptr<const std::set<std::string>> tombstones,
+			 std::shared_ptr<PatternCache> cache);
+
+	/// Like matching. counted says whether this goes toward the cache's hit
+	/// and miss counts.
+	Matches matching(const std::string& pattern, bool counted) const;
+
+	/// Returns a new snapshot with a batch of uppercase words inserted and
+	/// deleted. Only the inserted words are indexed, as a new delta segment.
+	std::shared_ptr<const Wordlist> withUpdates(
+		const std::vector<std::string>& inserts,
+		const std::vector<std::string>& deletes) const;
+	/// Returns true if enough deltas and tombstones have built up that lookups
+	/// would benefit from merging everything back into one segment.
+	bool needsCompaction() const;
+	/// Returns a single segment holding every word in this snapshot.
+	std::shared_ptr<const Segment> merged() const;
+	/// Returns the equivalent of this snapshot with the segments and tombstones
+	/// of compacted, an earlier snapshot, replaced by merged, which must have
+	/// been built from compacted.
+	std::shared_ptr<const Wordlist> rebased(
+		const Wordlist& compacted,
+		std::shared_ptr<const Segment> merged) const;
+
+	/// The base segment followed by delta segments, oldest first.
+	std::vector<std::shared_ptr<const Segment>> segments_;
+	/// The first ID of each segment.
+	std::vector<int> offsets_;
+	/// Words deleted from one of the segments.
+	std::shared_ptr<const std::set<std::string>> tombstones_;
+	std::shared_ptr<PatternCache> cache_;
+	/// What this snapshot's combined matches are cached under. A snapshot that
+	/// is just its base segment shares the segment's cache entries.
+	size_t cacheId_;
+};
+
+/// A dictionary that can be updated while searches are running. Each search
+/// works against the snapshot it started with, and every snapshot taken after
+/// an update sees it. Updates come from calls to update or from a file being
+/// followed. They only index the words they insert; a background thread folds
+/// deltas and tombstones back into one segment once enough of them pile up.
+class LiveWordlist {
+   public:
+	explicit LiveWordlist(const std::set<std::string>& words,
+						  size_t cacheBytes = Wordlist::DEFAULT_CACHE_BYTES);
+	~LiveWordlist();
+
+	/// Returns the current state of the dictionary. The snapshot is never
+	/// modified, no matter what updates come in while it's in use.
+	std::shared_ptr<const Wordlist> snapshot() const;
+	/// Applies a batch of insertions and deletions of uppercase words.
+	/// Inserting a word that's already present or deleting one that isn't does
+	/// nothing.
+	void update(const std::vector<std::string>& inserts,
+				const std::vector<std::string>& deletes);
+	/// Applies updates from filename, one per line: +WORD inserts a word and
+	/// -WORD deletes one. Letters may be in either case, and invalid lines are
+	/// skipped. Every complete line already in the file is applied before this
+	/// returns, so the next snapshot reflects them. After that, the file is
+	/// checked for appended lines every intervalMilliseconds. It needn't exist
+	/// yet, and if it shrinks it's taken to have been replaced and is applied
+	/// again from the start. Call at most once.
+	void follow(const std::string& filename, int intervalMilliseconds = 100);
+
+   private:
+	/// The background compaction loop.
+	void compact();
+	/// The background loop applying updates from a followed file, the first
+	/// applied bytes of which have already been applied.
+	void followUpdates(const std::string& filename, int intervalMilliseconds,
+					   std::streamoff applied);
+	/// Applies every complete line of filename past its first *applied bytes,
+	/// then advances *applied past them.
+	void applyUpdates(const std::string& filename, std::streamoff* applied);
+
+	mutable std::mutex mutex_;
+	std::condition_variable compactionNeeded_, stopRequested_;
+	std::shared_ptr<const Wordlist> current_;
+	bool stopping_ = false;
+	std::thread compactor_, follower_;
+};
+
+#endif /* wordlist_h */
@@ -0,0 +1,210 @@
+//
+//  wordlist_test.cc
+//  CrosswordCreator
+//
+//  Created by Hunter Knepshield on 10/18/26.
+//  Copyright © 2026 Hunter Knepshield. All rights reserved.
+//
+
+// Tests for Wordlist and LiveWordlist updates.
+
+#include "wordlist.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_util.h"
+
+namespace {
+
+/// Returns every word in wordlist matching pattern.
+std::set<std::string> Matching(const Wordlist& wordlist,
+							   const std::string& pattern) {
+	std::set<std::string> words;
+	const auto matches = wordlist.matching(pattern);
+	for (int id : *matches) {
+		bool inserted = words.insert(wordlist.word(id)).second;
+		// No word should ever show up twice.
+		CHECK(inserted);
+	}
+	return words;
+}
+
+/// Returns true if wordlist holds exactly words, checking both lookups and
+/// pattern matches.
+bool Holds(const Wordlist& wordlist, const std::set<std::string>& words,
+		   const std::vector<std::string>& universe) {
+	for (const auto& word : universe) {
+		if (wordlist.contains(word) != (words.find(word) != words.end()))
+			return false;
+	}
+	for (size_t length = 1; length <= 5; length++) {
+		std::set<std::string> expected;
+		for (const auto& word : words)
+			if (word.size() == length) expected.insert(word);
+		if (Matching(wordlist, std::string(length, Wordlist::WILDCARD)) !=
+			expected)
+			return false;
+	}
+	return true;
+}
+
+/// Waits up to a few seconds for condition to become true.
+bool Eventually(const std::function<bool()>& condition) {
+	for (int i = 0; i < 300; i++) {
+		if (condition()) return true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	return false;
+}
+
+}  // namespace
+
+class WordlistTest {
+   public:
+	static void InsertAndDelete() {
+		Wordlist base({"CAT", "COT", "DOG"});
+		auto updated = base.withUpdates({"CUT"}, {"COT"});
+		CHECK(Matching(*updated, "C.T") ==
+			   std::set<std::string>({"CAT", "CUT"}));
+		CHECK(updated->contains("CUT") && !updated->contains("COT"));
+		// The older snapshot never changes.
+		CHECK(Matching(base, "C.T") == std::set<std::string>({"CAT", "COT"}));
+		CHECK(!base.contains("CUT") && base.contains("COT"));
+
+		// Repeated lookups are served from the cache, and count once each no
+		// matter how many segments the snapshot has.
+		const auto before = updated->cacheStats();
+		const auto first = updated->matching("C.T");
+		const auto second = updated->matching("C.T");
+		const auto after = updated->cacheStats();
+		CHECK(first == second);
+		CHECK(after.hits == before.hits + 2);
+		CHECK(after.misses == before.misses);
+	}
+
+	static void ReinsertTombstoned() {
+		Wordlist base({"CAT", "COT", "DOG"});
+		auto deleted = base.withUpdates({}, {"COT"});
+		auto reinserted = deleted->withUpdates({"COT"}, {});
+		CHECK(reinserted->contains("COT"));
+		CHECK(Matching(*reinserted, "CO.") == std::set<std::string>({"COT"}));
+		// Re-inserting only clears the tombstone.
+		CHECK(reinserted->segments_.size() == 1);
+		CHECK(reinserted->tombstones_->empty());
+
+		// The same goes for words that were themselves inserted by an update.
+		auto added = base.withUpdates({"EEL"}, {});
+		auto again = added->withUpdates({}, {"EEL"})->withUpdates({"EEL"}, {});
+		CHECK(Matching(*again, "E..") == std::set<std::string>({"EEL"}));
+		// Inserting and deleting in one batch deletes.
+		CHECK(!base.withUpdates({"EEL"}, {"EEL"})->contains("EEL"));
+	}
+
+	static void CompactionRacingUpdate() {
+		const std::vector<std::string> universe = {"BAT", "CAT", "COT",
+												   "CUT", "DOG", "EEL"};
+		Wordlist base({"CAT", "COT", "DOG"});
+		// Compaction starts from this snapshot...
+		auto source = base.withUpdates({"CUT"}, {"COT"});
+		auto merged = source->merged();
+		// ...while updates keep coming in: one brings back a word the merge
+		// left out, one deletes a word the merge kept, and one adds a word.
+		auto current = source->withUpdates({"COT"}, {})
+						   ->withUpdates({"BAT"}, {"CAT"})
+						   ->withUpdates({"EEL"}, {});
+		auto rebased = current->rebased(*source, merged);
+		const std::set<std::string> expected = {"BAT", "COT", "CUT", "DOG",
+												"EEL"};
+		CHECK(Holds(*current, expected, universe));
+		CHECK(Holds(*rebased, expected, universe));
+		CHECK(rebased->segments_.front() == merged);
+		CHECK(*rebased->tombstones_ == std::set<std::string>({"CAT"}));
+	}
+
+	static void ConcurrentUpdates() {
+		std::mt19937 generator(1);
+		std::vector<std::string> universe;
+		for (int i = 0; i < 2000; i++) {
+			std::string word;
+			for (int j = 0; j < 2 + i % 4; j++)
+				word += "AEIRST"[generator() % 6];
+			universe.push_back(word);
+		}
+		std::set<std::string> words(universe.begin(), universe.begin() + 500);
+		LiveWordlist live(words, 1 << 16);
+
+		// Keep looking things up while updates and compactions happen.
+		std::atomic<bool> done(false);
+		std::thread reader([&]() {
+			while (!done) {
+				const auto snapshot = live.snapshot();
+				Matching(*snapshot, "A..");
+				Matching(*snapshot, ".E.T");
+			}
+		});
+		for (int round = 0; round < 100; round++) {
+			std::vector<std::string> inserts, deletes;
+			for (int i = 0; i < 10; i++) {
+				inserts.push_back(universe[generator() % universe.size()]);
+				deletes.push_back(universe[generator() % universe.size()]);
+			}
+			const auto before = live.snapshot();
+			const auto wordsBefore = words;
+			live.update(inserts, deletes);
+			for (const auto& word : inserts) words.insert(word);
+			for (const auto& word : deletes) words.erase(word);
+			CHECK(Holds(*live.snapshot(), words, universe));
+			CHECK(Holds(*before, wordsBefore, universe));
+		}
+		done = true;
+		reader.join();
+	}
+
+	static void FollowFile() {
+		const std::string filename = "wordlist_test.updates";
+		{
+			std::ofstream file(filename);
+			file << "+cut\n-COT\n+D0G\nBAT\n+EEL\n-EEL\n+EEL";
+		}
+		LiveWordlist live({"CAT", "COT", "DOG"});
+		live.follow(filename, 10);
+		// Lines already in the file are applied before follow returns.
+		const auto snapshot = live.snapshot();
+		CHECK(snapshot->contains("CUT"));
+		CHECK(!snapshot->contains("COT"));
+		// Invalid lines are skipped, and the last change to a word wins.
+		CHECK(!snapshot->contains("BAT"));
+		// The last line isn't finished yet.
+		CHECK(!snapshot->contains("EEL"));
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		CHECK(!live.snapshot()->contains("EEL"));
+		{
+			std::ofstream file(filename, std::ios::app);
+			file << "\n+COT\n";
+		}
+		CHECK(Eventually([&]() {
+			const auto snapshot = live.snapshot();
+			return snapshot->contains("EEL") && snapshot->contains("COT");
+		}));
+		std::remove(filename.c_str());
+	}
+};
+
+void RunWordlistTests() {
+	WordlistTest::InsertAndDelete();
+	WordlistTest::ReinsertTombstoned();
+	WordlistTest::CompactionRacingUpdate();
+	WordlistTest::ConcurrentUpdates();
+	WordlistTest::FollowFile();
+}